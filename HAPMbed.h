@@ -8,6 +8,68 @@
 
 #include "events/EventQueue.h"
 
+#include "HAPPlatformClock+Monotonic.h"
+#include "HAPPlatformRunLoop+Priority.h"
+
+// Dispatched by the run loop.
 extern events::EventQueue eventQueue;
 
-#endif
\ No newline at end of file
+// Chained to eventQueue and only dispatched when eventQueue has no pending events.
+extern events::EventQueue backgroundQueue;
+
+// Queue statistics kept by the run loop. Only to be called by the templates below, events are cancelled through
+// HAPMbedCancelEvent so that the depth of the queues stays correct.
+namespace HAPMbedInternal {
+void EventWillPost(HAPPlatformRunLoopPriority priority);
+void EventDidPost(HAPPlatformRunLoopPriority priority, int id);
+void EventWillDispatch(HAPPlatformRunLoopPriority priority, HAPMonotonicTime due, bool isImmediate);
+}
+
+/**
+ * Posts an event for immediate dispatch on the queue with the given priority.
+ *
+ * @return Event ID or 0 if the queue has no memory left.
+ */
+template <typename F>
+int HAPMbedPostEvent(HAPPlatformRunLoopPriority priority, F f) {
+    auto &queue = priority == kHAPPlatformRunLoopPriority_High ? eventQueue : backgroundQueue;
+    auto due = HAPPlatformClockGetMonotonic();
+
+    HAPMbedInternal::EventWillPost(priority);
+
+    int id = queue.call([priority, due, f] {
+        HAPMbedInternal::EventWillDispatch(priority, due, true);
+        f();
+    });
+    HAPMbedInternal::EventDidPost(priority, id);
+    return id;
+}
+
+/**
+ * Posts an event for delayed dispatch on the queue with the given priority.
+ *
+ * @return Event ID or 0 if the queue has no memory left.
+ */
+template <typename F>
+int HAPMbedPostEventIn(HAPPlatformRunLoopPriority priority, std::chrono::milliseconds delay, F f) {
+    auto &queue = priority == kHAPPlatformRunLoopPriority_High ? eventQueue : backgroundQueue;
+    auto due = HAPPlatformClockGetMonotonic() + (HAPMonotonicTime)delay.count() * 1000;
+
+    return queue.call_in(delay, [priority, due, f] {
+        HAPMbedInternal::EventWillDispatch(priority, due, false);
+        f();
+    });
+}
+
+/**
+ * Cancels an event posted with HAPMbedPostEvent or HAPMbedPostEventIn.
+ *
+ * @param      priority             Priority the event was posted with.
+ * @param      id                   Event ID, 0 is ignored.
+ * @param      isImmediate          Whether the event was posted with HAPMbedPostEvent.
+ *
+ * @return true if the event was cancelled before being dispatched.
+ */
+bool HAPMbedCancelEvent(HAPPlatformRunLoopPriority priority, int id, bool isImmediate);
+
+#endif
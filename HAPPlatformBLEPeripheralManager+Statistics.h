@@ -0,0 +1,52 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_STATISTICS_H
+#define HAP_PLATFORM_BLE_PERIPHERAL_MANAGER_STATISTICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * BLE peripheral manager statistics.
+ */
+typedef struct {
+    /** Number of established connections. */
+    uint32_t numConnections;
+
+    /** Number of terminated connections. */
+    uint32_t numDisconnections;
+
+    /** Number of ATT read requests passed on to the accessory server. */
+    uint32_t numReadRequests;
+
+    /** Number of ATT write requests passed on to the accessory server. */
+    uint32_t numWriteRequests;
+
+    /** Number of handle value indications sent. */
+    uint32_t numIndications;
+
+    /** Number of broadcast windows started. */
+    uint32_t numBroadcasts;
+
+    /** Whether a central is currently connected. */
+    bool isConnected;
+} HAPPlatformBLEPeripheralManagerStatistics;
+
+/**
+ * Fetches the BLE peripheral manager statistics.
+ *
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformBLEPeripheralManagerGetStatistics(HAPPlatformBLEPeripheralManagerStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
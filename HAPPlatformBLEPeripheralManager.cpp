@@ -11,16 +11,29 @@
 #include "HAPCrypto.h"
 #include "HAPMbed.h"
 #include "HAPPlatformBLEPeripheralManager+Init.h"
+#include "HAPPlatformBLEPeripheralManager+Statistics.h"
+#include "HAPPlatformCoalescer.h"
+#include "HAPPlatformSRP.h"
+#include "HAPPlatformTelemetry.h"
 
-#if HAP_LOG_LEVEL
+// The serial telemetry dump needs the USB console as well.
+#if HAP_LOG_LEVEL || HAP_TELEMETRY_SERIAL_DUMP
 #include "mbed.h"
 #include "USBSerial.h"
 
 class USBLogger: public USBSerial {
+public:
+    // Logging builds wait for a terminal to see everything from boot. Otherwise the console must never block the run
+    // loop on an accessory without a host attached.
+    USBLogger(): USBSerial(HAP_LOG_LEVEL != 0) {}
+
 protected:
     int _putc(int c) override {
         int ret;
 
+        // Drop output while no terminal has opened the port.
+        if (!connected()) return c;
+
         if (c == '\n') {
             static uint8_t nlcr[] = {'\r', '\n'};
             ret = send(nlcr, 2);
@@ -56,6 +69,7 @@ static ble::advertising_handle_t _advertisingHandle = ble::LEGACY_ADVERTISING_HA
 static GattCharacteristic*       _chrs[kAttributeCount];
 static GattAttribute*            _dscs[kAttributeCount];
 static uintptr_t                 _connectionHandle = 0;
+static bool                      _isConnected = false;
 static uint8_t                   _lastIndex = 0;
 static uint8_t                   _index = 0;
 
@@ -63,6 +77,21 @@ static HAPBLEAdvertisingInterval               _advertisingInterval = 0;
 static HAPPlatformBLEPeripheralManagerRef      _blePeripheralManager = nullptr;
 static HAPPlatformBLEPeripheralManagerDelegate _delegate;
 
+// Whether an encrypted notification advertisement is on air. The accessory server bounds the broadcast window and
+// replaces it with a regular advertisement carrying the current GSN.
+static bool _isBroadcasting = false;
+
+static HAPPlatformBLEPeripheralManagerStatistics _stats;
+
+#if HAP_TELEMETRY_GATT_SERVICE
+// Vendor diagnostics service with a single read-only characteristic holding the serialized telemetry samples.
+static const UUID _diagnosticsServiceUUID("6d3b0001-5c1e-4b7a-9d5e-3f6a1c2b7e90");
+static const UUID _diagnosticsSamplesUUID("6d3b0002-5c1e-4b7a-9d5e-3f6a1c2b7e90");
+
+static GattCharacteristic* _diagnosticsCharacteristic = nullptr;
+static uint8_t _diagnosticsBytes[HAPMin(2 + HAP_TELEMETRY_NUM_SAMPLES * kHAPPlatformTelemetry_SampleSize, ATT_VALUE_MAX_LEN)];
+#endif
+
 void onInitComplete(BLE::InitializationCompleteCallbackContext *event) {
     if (event->error) {
         HAPLogError(&logObject, "BLE initialization failed %d", event->error);
@@ -73,7 +102,28 @@ void onInitComplete(BLE::InitializationCompleteCallbackContext *event) {
 }
 
 void scheduleEvents(BLE::OnEventsToProcessCallbackContext *event) {
-    eventQueue.call(&event->ble, &BLE::processEvents);
+    HAPMbedPostEvent(kHAPPlatformRunLoopPriority_High, [ble = &event->ble] { ble->processEvents(); });
+}
+
+const uint8_t* findManufacturerData(const uint8_t* bytes, size_t numBytes, uint8_t type) {
+    // Apple manufacturer data of a HAP-BLE advertisement: length, 0xFF, 0x004C, type, STL, ...
+    for (size_t i = 0; i + 5 < numBytes && i + bytes[i] < numBytes; i += bytes[i] + 1) {
+        if (bytes[i] >= 5 && bytes[i + 1] == 0xFF && bytes[i + 2] == 0x4C && bytes[i + 3] == 0x00 && bytes[i + 4] == type) {
+            return &bytes[i];
+        }
+    }
+    return nullptr;
+}
+
+bool isAccessoryPaired(const uint8_t* bytes, size_t numBytes) {
+    // Regular advertisement (0x06) with the status flags following STL.
+    auto data = findManufacturerData(bytes, numBytes, 0x06);
+    return !data || data[0] < 6 || !(data[6] & 0x01);
+}
+
+bool isBroadcast(const uint8_t* bytes, size_t numBytes) {
+    // Encrypted notification advertisement (0x11).
+    return findManufacturerData(bytes, numBytes, 0x11) != nullptr;
 }
 
 void updateCentralConnection(uintptr_t connectionHandle) {
@@ -83,6 +133,8 @@ void updateCentralConnection(uintptr_t connectionHandle) {
                 _delegate.handleDisconnectedCentral(_blePeripheralManager, _connectionHandle, _delegate.context);
             }
             _connectionHandle = 0;
+
+            HAPPlatformCoalescerFlush();
         }
         if (connectionHandle != 0) {
             _connectionHandle = connectionHandle;
@@ -101,6 +153,8 @@ void handleReadRequest(GattReadAuthCallbackParams* params) {
     if (!params->offset) {
         HAPLogDebug(&logObject, "(0x%04x) ATT Read Request.", params->handle);
 
+        _stats.numReadRequests++;
+
         auto err = _delegate.handleReadRequest(_blePeripheralManager, params->connHandle, params->handle, _readBuffer.bytes, sizeof _readBuffer.bytes, (size_t*)&_readBuffer.size, _delegate.context);
 
         if (err) {
@@ -136,6 +190,8 @@ void handleReadRequest(GattReadAuthCallbackParams* params) {
 void handleWriteRequest(GattWriteAuthCallbackParams *params) {
     updateCentralConnection(params->connHandle);
 
+    _stats.numWriteRequests++;
+
     auto err = _delegate.handleWriteRequest(_blePeripheralManager, params->connHandle, params->handle, (void*)params->data, params->len, _delegate.context);
 
     if (err) {
@@ -149,6 +205,33 @@ void handleWriteRequest(GattWriteAuthCallbackParams *params) {
     params->authorizationReply = AUTH_CALLBACK_REPLY_SUCCESS;
 }
 
+#if HAP_TELEMETRY_GATT_SERVICE
+void handleDiagnosticsReadRequest(GattReadAuthCallbackParams* params) {
+    // Read Blob Requests are served from the value stored by the preceding Read Request.
+    if (!params->offset) {
+        params->len = (uint16_t)HAPPlatformTelemetrySerialize(_diagnosticsBytes, sizeof _diagnosticsBytes);
+        params->data = _diagnosticsBytes;
+    }
+    params->authorizationReply = AUTH_CALLBACK_REPLY_SUCCESS;
+}
+
+void addDiagnosticsService() {
+    if (!_diagnosticsCharacteristic) {
+        _diagnosticsCharacteristic = new GattCharacteristic {_diagnosticsSamplesUUID, _diagnosticsBytes, 0, sizeof _diagnosticsBytes, GattCharacteristic::BLE_GATT_CHAR_PROPERTIES_READ, nullptr, 0};
+        _diagnosticsCharacteristic->setReadAuthorizationCallback(handleDiagnosticsReadRequest);
+    }
+
+    GattService svc { _diagnosticsServiceUUID, &_diagnosticsCharacteristic, 1 };
+
+    auto &ble = BLE::Instance();
+    auto &server = ble.gattServer();
+
+    if (auto err = server.addService(svc)) {
+        HAPLogError(&logObject, "ble::GattServer::addService() failed %d", err);
+    }
+}
+#endif
+
 struct EventHandler : private mbed::NonCopyable<EventHandler>, public ble::Gap::EventHandler, public ble::GattServer::EventHandler {
     void onAdvertisingEnd(const ble::AdvertisingEndEvent &event) override {
         if (!_advertisingInterval) return;
@@ -176,12 +259,24 @@ struct EventHandler : private mbed::NonCopyable<EventHandler>, public ble::Gap::
         } else {
             auto addr = event.getPeerAddress();
             HAPLog(&logObject, "Connected to: %02x:%02x:%02x:%02x:%02x:%02x", addr[5], addr[4], addr[3], addr[2], addr[1], addr[0]);
+
+            _stats.numConnections++;
+
+            // The connection handle is only known with the first ATT request.
+            _isConnected = true;
+            HAPPlatformSRPSetConnected(true);
+            HAPPlatformSRPStopPrecomputation();
         }
     }
 
     void onDisconnectionComplete(const ble::DisconnectionCompleteEvent &event) override {
         HAPLog(&logObject, "Disconnected with reason %02x.", event.getReason().value());
 
+        _stats.numDisconnections++;
+
+        _isConnected = false;
+        HAPPlatformSRPSetConnected(false);
+
         updateCentralConnection(0);
     }
 
@@ -405,6 +500,10 @@ void HAPPlatformBLEPeripheralManagerPublishServices(HAPPlatformBLEPeripheralMana
     auto &ble = BLE::Instance();
     auto &server = ble.gattServer();
 
+#if HAP_TELEMETRY_GATT_SERVICE
+    addDiagnosticsService();
+#endif
+
     server.setEventHandler(&_eventHandler);
 
     delete[] _handles;
@@ -428,8 +527,17 @@ void HAPPlatformBLEPeripheralManagerStartAdvertising(
     auto &ble = BLE::Instance();
     auto &gap = ble.gap();
 
+    auto previousInterval = _advertisingInterval;
+    auto broadcast = isBroadcast((const uint8_t*)advertisingBytes, numAdvertisingBytes);
+
     _advertisingInterval = advertisingInterval;
 
+    if (broadcast && !_isBroadcasting) {
+        _stats.numBroadcasts++;
+    }
+    _isBroadcasting = broadcast;
+
+    // The payload of an active advertising set is replaced in place and goes out with the next advertising event.
     if (advertisingBytes && numAdvertisingBytes) {
         if (auto err = gap.setAdvertisingPayload(_advertisingHandle, { (uint8_t*)advertisingBytes, (uint8_t)numAdvertisingBytes })) {
             HAPLogError(&logObject, "Gap::setAdvertisingPayload() failed %d", err);
@@ -442,9 +550,20 @@ void HAPPlatformBLEPeripheralManagerStartAdvertising(
         }
     }
 
+    // Precompute the SRP ephemeral for the next pair setup while nobody is connected.
+    if (_isConnected || broadcast || isAccessoryPaired((const uint8_t*)advertisingBytes, numAdvertisingBytes)) {
+        HAPPlatformSRPStopPrecomputation();
+    } else {
+        HAPPlatformSRPStartPrecomputation();
+    }
+
     if (gap.isAdvertisingActive(_advertisingHandle)) {
-        if (auto err = gap.stopAdvertising(_advertisingHandle)) {
-            HAPLogError(&logObject, "ble::Gap::stopAdvertising() failed %d", err);
+        // Only a new interval needs a restart, which onAdvertisingEnd performs. A stop that is already in flight
+        // restarts with the new interval as well.
+        if (previousInterval && previousInterval != advertisingInterval) {
+            if (auto err = gap.stopAdvertising(_advertisingHandle)) {
+                HAPLogError(&logObject, "ble::Gap::stopAdvertising() failed %d", err);
+            }
         }
     } else {
         ble::AdvertisingParameters params(
@@ -471,6 +590,9 @@ void HAPPlatformBLEPeripheralManagerStopAdvertising(HAPPlatformBLEPeripheralMana
     auto &gap = ble.gap();
 
     _advertisingInterval = 0;
+    _isBroadcasting = false;
+
+    HAPPlatformSRPStopPrecomputation();
 
     if (gap.isAdvertisingActive(_advertisingHandle)) {
         if (auto err = gap.stopAdvertising(_advertisingHandle)) {
@@ -507,5 +629,13 @@ HAPError HAPPlatformBLEPeripheralManagerSendHandleValueIndication(
         HAPLogError(&logObject, "ble::GattServer::write() failed %d", err);
         return kHAPError_InvalidState;
     }
+    _stats.numIndications++;
     return kHAPError_None;
 }
+
+void HAPPlatformBLEPeripheralManagerGetStatistics(HAPPlatformBLEPeripheralManagerStatistics* statistics) {
+    HAPPrecondition(statistics);
+
+    *statistics = _stats;
+    statistics->isConnected = _isConnected;
+}
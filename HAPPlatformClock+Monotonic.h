@@ -0,0 +1,45 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_CLOCK_MONOTONIC_H
+#define HAP_PLATFORM_CLOCK_MONOTONIC_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Monotonic time in microseconds.
+ */
+typedef uint64_t HAPMonotonicTime;
+
+/**
+ * Returns the current value of a 64-bit, free-running monotonic clock in microseconds.
+ *
+ * On Mbed OS this is the extended microsecond ticker, which never wraps within the lifetime of the device but does not
+ * advance while the system is in deep sleep. On the host it is CLOCK_MONOTONIC.
+ *
+ * @return Current monotonic time in microseconds.
+ */
+HAP_RESULT_USE_CHECK
+HAPMonotonicTime HAPPlatformClockGetMonotonic(void);
+
+/**
+ * Returns the average cost of a single HAPPlatformClockGetMonotonic call in nanoseconds.
+ *
+ * The value is calibrated on first use and should be subtracted from measured intervals that are close to it.
+ *
+ * @return Read overhead in nanoseconds.
+ */
+HAP_RESULT_USE_CHECK
+uint32_t HAPPlatformClockGetMonotonicReadOverhead(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -4,9 +4,48 @@
 // you may not use this file except in compliance with the License.
 
 #include "HAPPlatform.h"
+#include "HAPPlatformClock+Monotonic.h"
 
+#if defined(__MBED__)
+#include "drivers/HighResClock.h"
 #include "rtos/Kernel.h"
 
 HAPTime HAPPlatformClockGetCurrent(void) {
     return (HAPTime)rtos::Kernel::Clock::now().time_since_epoch().count();
 }
+
+HAPMonotonicTime HAPPlatformClockGetMonotonic(void) {
+    return (HAPMonotonicTime)mbed::HighResClock::now().time_since_epoch().count();
+}
+#else
+#include <time.h>
+
+HAPTime HAPPlatformClockGetCurrent(void) {
+    return HAPPlatformClockGetMonotonic() / 1000;
+}
+
+HAPMonotonicTime HAPPlatformClockGetMonotonic(void) {
+    struct timespec now;
+
+    int err = clock_gettime(CLOCK_MONOTONIC, &now);
+    HAPAssert(!err);
+
+    return (HAPMonotonicTime)now.tv_sec * 1000000 + (HAPMonotonicTime)now.tv_nsec / 1000;
+}
+#endif
+
+uint32_t HAPPlatformClockGetMonotonicReadOverhead(void) {
+    static const uint32_t numReads = 128;
+    static uint32_t overhead = UINT32_MAX;
+
+    if (overhead == UINT32_MAX) {
+        HAPMonotonicTime start = HAPPlatformClockGetMonotonic();
+        HAPMonotonicTime end = start;
+
+        for (uint32_t i = 0; i < numReads; ++i) {
+            end = HAPPlatformClockGetMonotonic();
+        }
+        overhead = (uint32_t)((end - start) * 1000 / numReads);
+    }
+    return overhead;
+}
@@ -0,0 +1,183 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#include "HAPPlatformCoalescer.h"
+#include "HAPMbed.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "Coalescer" };
+
+static struct Event {
+    HAPAccessoryServerRef* server;
+    const HAPCharacteristic* characteristic;
+    const HAPService* service;
+    const HAPAccessory* accessory;
+    uint32_t numSaved;
+    int id;
+    bool isPending;
+} _events[HAP_COALESCER_MAX_CHARACTERISTICS];
+
+static struct {
+    HAPPlatformCoalescerPersistenceCallback callback;
+    uint32_t numChanges;
+    int id;
+    int idleId;
+    bool isFlushing;
+} _persistence;
+
+static HAPPlatformCoalescerStatistics _stats;
+
+static void raiseEvent(Event *event) {
+    HAPAccessoryServerRaiseEvent(event->server, event->characteristic, event->service, event->accessory);
+    _stats.numEventsRaised++;
+}
+
+static void releaseEvent(Event *event) {
+    if (event->numSaved) {
+        HAPLogDebug(&logObject, "Merged %lu events.", (unsigned long)event->numSaved);
+        _stats.lastBurstEventsSaved = event->numSaved;
+    }
+    HAPRawBufferZero(event, sizeof *event);
+}
+
+static void closeWindow(Event *event) {
+    event->id = 0;
+
+    if (event->isPending) {
+        event->isPending = false;
+        raiseEvent(event);
+
+        // Keep merging for as long as changes keep coming in.
+        event->id = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_High, std::chrono::milliseconds(HAP_COALESCER_EVENT_WINDOW), [event] {
+            closeWindow(event);
+        });
+        if (event->id) return;
+    }
+    releaseEvent(event);
+}
+
+static void persist() {
+    auto callback = _persistence.callback;
+    auto numSaved = _persistence.numChanges - 1;
+
+    if (!callback) return;
+
+    HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_Background, _persistence.id, _persistence.isFlushing);
+    HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_Background, _persistence.idleId, false);
+    HAPRawBufferZero(&_persistence, sizeof _persistence);
+
+    callback();
+
+    _stats.numWrites++;
+    _stats.numWritesSaved += numSaved;
+    _stats.lastBurstWritesSaved = numSaved;
+
+    if (numSaved) {
+        HAPLogDebug(&logObject, "Saved %lu writes.", (unsigned long)numSaved);
+    }
+}
+
+void HAPPlatformCoalescerRaiseEvent(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory) {
+    HAPPrecondition(server);
+    HAPPrecondition(characteristic);
+    HAPPrecondition(service);
+    HAPPrecondition(accessory);
+
+    Event *slot = nullptr;
+
+    for (auto &event : _events) {
+        if (!event.characteristic) {
+            if (!slot) slot = &event;
+        } else if (event.characteristic == characteristic && event.service == service && event.accessory == accessory) {
+            if (event.isPending) {
+                event.numSaved++;
+                _stats.numEventsSaved++;
+            }
+            event.isPending = true;
+            return;
+        }
+    }
+
+    Event event = { server, characteristic, service, accessory, 0, 0, false };
+    raiseEvent(&event);
+
+    if (!slot) {
+        HAPLog(&logObject, "No free slot, raising events without merging.");
+        return;
+    }
+    *slot = event;
+    slot->id = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_High, std::chrono::milliseconds(HAP_COALESCER_EVENT_WINDOW), [slot] {
+        closeWindow(slot);
+    });
+    if (!slot->id) {
+        releaseEvent(slot);
+    }
+}
+
+void HAPPlatformCoalescerSchedulePersistence(HAPPlatformCoalescerPersistenceCallback callback) {
+    HAPPrecondition(callback);
+
+    if (_persistence.callback && _persistence.callback != callback) {
+        persist();
+    }
+    _persistence.callback = callback;
+    _persistence.numChanges++;
+
+    // The delay runs from the first change so that a steady stream of changes can't postpone the write indefinitely.
+    if (!_persistence.id) {
+        _persistence.id = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_Background, std::chrono::milliseconds(HAP_COALESCER_PERSISTENCE_DELAY), [] {
+            _persistence.id = 0;
+            persist();
+        });
+
+        if (!_persistence.id) {
+            persist();
+            return;
+        }
+    }
+
+    // Once the changes stop, the burst is over and there is no point in waiting for the full delay.
+    HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_Background, _persistence.idleId, false);
+    _persistence.idleId = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_Background, std::chrono::milliseconds(HAP_COALESCER_IDLE_DELAY), [] {
+        _persistence.idleId = 0;
+        persist();
+    });
+}
+
+void HAPPlatformCoalescerFlush(void) {
+    for (auto &event : _events) {
+        if (!event.characteristic) continue;
+
+        HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_High, event.id, false);
+        if (event.isPending) {
+            raiseEvent(&event);
+        }
+        releaseEvent(&event);
+    }
+
+    if (_persistence.callback && !_persistence.isFlushing) {
+        // Write right away, but on the background queue so that the flash write doesn't hold up the radio stack.
+        HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_Background, _persistence.id, false);
+        _persistence.id = HAPMbedPostEvent(kHAPPlatformRunLoopPriority_Background, [] {
+            _persistence.id = 0;
+            persist();
+        });
+
+        if (_persistence.id) {
+            _persistence.isFlushing = true;
+        } else {
+            persist();
+        }
+    }
+}
+
+void HAPPlatformCoalescerGetStatistics(HAPPlatformCoalescerStatistics* statistics) {
+    HAPPrecondition(statistics);
+
+    *statistics = _stats;
+}
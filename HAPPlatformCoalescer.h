@@ -0,0 +1,114 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_COALESCER_H
+#define HAP_PLATFORM_COALESCER_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAP.h"
+
+/**
+ * Time in milliseconds during which repeated events of the same characteristic are merged into one.
+ */
+#ifndef HAP_COALESCER_EVENT_WINDOW
+#define HAP_COALESCER_EVENT_WINDOW 250
+#endif
+
+/**
+ * Maximum time in milliseconds by which persisting the accessory state is deferred after the first change.
+ */
+#ifndef HAP_COALESCER_PERSISTENCE_DELAY
+#define HAP_COALESCER_PERSISTENCE_DELAY 2000
+#endif
+
+/**
+ * Time in milliseconds without further changes after which the accessory state is persisted before
+ * HAP_COALESCER_PERSISTENCE_DELAY has passed.
+ */
+#ifndef HAP_COALESCER_IDLE_DELAY
+#define HAP_COALESCER_IDLE_DELAY 500
+#endif
+
+/**
+ * Maximum number of characteristics with events being merged at the same time.
+ */
+#ifndef HAP_COALESCER_MAX_CHARACTERISTICS
+#define HAP_COALESCER_MAX_CHARACTERISTICS 8
+#endif
+
+/**
+ * Callback that persists the accessory state.
+ */
+typedef void (*HAPPlatformCoalescerPersistenceCallback)(void);
+
+/**
+ * Coalescer statistics.
+ */
+typedef struct {
+    /** Number of events passed on to the accessory server. */
+    uint32_t numEventsRaised;
+
+    /** Number of events merged into a later one. */
+    uint32_t numEventsSaved;
+
+    /** Number of times the accessory state was persisted. */
+    uint32_t numWrites;
+
+    /** Number of state changes that did not need a write of their own. */
+    uint32_t numWritesSaved;
+
+    /** Number of events merged during the last burst. */
+    uint32_t lastBurstEventsSaved;
+
+    /** Number of writes saved during the last burst. */
+    uint32_t lastBurstWritesSaved;
+} HAPPlatformCoalescerStatistics;
+
+/**
+ * Raises an event for a changed characteristic.
+ *
+ * The first change is raised immediately. Further changes within HAP_COALESCER_EVENT_WINDOW are merged into a single
+ * event at the end of the window, at which point the accessory server reads the latest value.
+ *
+ * @param      server               Accessory server.
+ * @param      characteristic       The characteristic whose value has changed.
+ * @param      service              The service that contains the characteristic.
+ * @param      accessory            The accessory that provides the service.
+ */
+void HAPPlatformCoalescerRaiseEvent(
+        HAPAccessoryServerRef* server,
+        const HAPCharacteristic* characteristic,
+        const HAPService* service,
+        const HAPAccessory* accessory);
+
+/**
+ * Schedules the accessory state to be persisted on the background queue, either once no further changes happened for
+ * HAP_COALESCER_IDLE_DELAY or at the latest HAP_COALESCER_PERSISTENCE_DELAY after the first change.
+ *
+ * @param      callback             Function that persists the accessory state.
+ */
+void HAPPlatformCoalescerSchedulePersistence(HAPPlatformCoalescerPersistenceCallback callback);
+
+/**
+ * Raises all merged events and schedules a pending write of the accessory state for immediate dispatch on the
+ * background queue.
+ */
+void HAPPlatformCoalescerFlush(void);
+
+/**
+ * Fetches the coalescer statistics.
+ *
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformCoalescerGetStatistics(HAPPlatformCoalescerStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,43 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_KEY_VALUE_STORE_STATISTICS_H
+#define HAP_PLATFORM_KEY_VALUE_STORE_STATISTICS_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Key-value store statistics.
+ */
+typedef struct {
+    /** Number of key lookups. */
+    uint32_t numReads;
+
+    /** Number of values written to flash. */
+    uint32_t numWrites;
+
+    /** Number of keys removed from flash. */
+    uint32_t numRemoves;
+
+    /** Number of failed kvstore operations. */
+    uint32_t numErrors;
+} HAPPlatformKeyValueStoreStatistics;
+
+/**
+ * Fetches the key-value store statistics.
+ *
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformKeyValueStoreGetStatistics(HAPPlatformKeyValueStoreStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
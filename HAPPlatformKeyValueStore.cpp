@@ -4,6 +4,7 @@
 // you may not use this file except in compliance with the License.
 
 #include "HAPPlatformKeyValueStore+Init.h"
+#include "HAPPlatformKeyValueStore+Statistics.h"
 
 #include <stdlib.h>
 
@@ -12,6 +13,8 @@
 
 static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "KeyValueStore" };
 
+static HAPPlatformKeyValueStoreStatistics _stats;
+
 void HAPPlatformKeyValueStoreCreate(
         HAPPlatformKeyValueStoreRef keyValueStore,
         const HAPPlatformKeyValueStoreOptions* options) {
@@ -41,6 +44,8 @@ HAPError HAPPlatformKeyValueStoreGet(
 
     sprintf(path, "%s%02x%02x", keyValueStore->rootDirectory, domain, key);
 
+    _stats.numReads++;
+
     if (int res = kv_get_info(path, &info)) {
         HAPLogDebug(&logObject, "kv_get_info failed %d\n", MBED_GET_ERROR_CODE(res));
         *found = false;
@@ -49,6 +54,7 @@ HAPError HAPPlatformKeyValueStoreGet(
 
     if (int res = kv_get(path, bytes, info.size, numBytes)) {
         HAPLogError(&logObject, "kv_get failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         return kHAPError_Unknown;
     }
     *found = true;
@@ -71,8 +77,10 @@ HAPError HAPPlatformKeyValueStoreSet(
 
     if (int res = kv_set(path, bytes, numBytes, 0)) {
         HAPLogError(&logObject, "kv_set failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         return kHAPError_Unknown;
     }
+    _stats.numWrites++;
     return kHAPError_None;
 }
 
@@ -94,8 +102,10 @@ HAPError HAPPlatformKeyValueStoreRemove(
         return kHAPError_None;
     } else if (res) {
         HAPLogError(&logObject, "kv_remove failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         return kHAPError_Unknown;
     }
+    _stats.numRemoves++;
     return kHAPError_None;
 }
 
@@ -122,6 +132,7 @@ HAPError HAPPlatformKeyValueStoreEnumerate(
         err = kHAPError_None;
     } else if (res) {
         HAPLogError(&logObject, "kv_iterator_open failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         err = kHAPError_Unknown;
     }
 
@@ -136,6 +147,7 @@ HAPError HAPPlatformKeyValueStoreEnumerate(
 
     if (res) {
         HAPLogError(&logObject, "kv_iterator_close failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         err = kHAPError_Unknown;
     }
     return err;
@@ -161,6 +173,7 @@ HAPError HAPPlatformKeyValueStorePurgeDomain(
         err = kHAPError_None;
     } else if (res) {
         HAPLogError(&logObject, "kv_iterator_open failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         err = kHAPError_Unknown;
     }
 
@@ -169,7 +182,10 @@ HAPError HAPPlatformKeyValueStorePurgeDomain(
 
         if (res) {
             HAPLogError(&logObject, "kv_remove failed %d\n", MBED_GET_ERROR_CODE(res));
+            _stats.numErrors++;
             err = kHAPError_Unknown;
+        } else {
+            _stats.numRemoves++;
         }
     }
 
@@ -177,8 +193,15 @@ HAPError HAPPlatformKeyValueStorePurgeDomain(
 
     if (res) {
         HAPLogError(&logObject, "kv_iterator_close failed %d\n", MBED_GET_ERROR_CODE(res));
+        _stats.numErrors++;
         err = kHAPError_Unknown;
     }
 
     return err;
 }
+
+void HAPPlatformKeyValueStoreGetStatistics(HAPPlatformKeyValueStoreStatistics* statistics) {
+    HAPPrecondition(statistics);
+
+    *statistics = _stats;
+}
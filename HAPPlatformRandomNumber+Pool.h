@@ -0,0 +1,79 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_RANDOM_NUMBER_POOL_H
+#define HAP_PLATFORM_RANDOM_NUMBER_POOL_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Size of the pre-filled entropy pool in bytes. Set to 0 to disable the pool, in which case every request is served
+ * synchronously by CryptoCell.
+ */
+#ifndef HAP_RANDOM_NUMBER_POOL_SIZE
+#define HAP_RANDOM_NUMBER_POOL_SIZE 256
+#endif
+
+/**
+ * Number of pool refills after which the CryptoCell DRBG is reseeded from its entropy source.
+ */
+#ifndef HAP_RANDOM_NUMBER_POOL_RESEED_INTERVAL
+#define HAP_RANDOM_NUMBER_POOL_RESEED_INTERVAL 64
+#endif
+
+/**
+ * Entropy pool statistics.
+ */
+typedef struct {
+    /** Number of requests served from the pool. */
+    uint32_t numHits;
+
+    /** Number of background refills. */
+    uint32_t numRefills;
+
+    /** Number of requests that fit the pool but had to be served synchronously because it was drained. */
+    uint32_t numStalls;
+
+    /** Number of DRBG reseeds. */
+    uint32_t numReseeds;
+
+    /** Number of HAPPlatformRandomNumberFill calls, with or without the pool. */
+    uint32_t numRequests;
+
+    /** Time in microseconds spent in HAPPlatformRandomNumberFill. Divide by numRequests to compare builds. */
+    uint32_t totalLatency;
+
+    /** Maximum time in microseconds spent in a single HAPPlatformRandomNumberFill call. */
+    uint32_t maxLatency;
+
+    /** Time in microseconds of the last request served synchronously by CryptoCell. */
+    uint32_t lastStallLatency;
+
+    /** Time in microseconds of the last background refill. */
+    uint32_t lastRefillLatency;
+} HAPPlatformRandomNumberPoolStatistics;
+
+/**
+ * Schedules the initial fill of the entropy pool on the background queue, so that it runs once the run loop is
+ * dispatching and CryptoCell has been initialized, well before the first pair verify.
+ */
+void HAPPlatformRandomNumberPoolPrefill(void);
+
+/**
+ * Fetches the entropy pool statistics.
+ *
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformRandomNumberPoolGetStatistics(HAPPlatformRandomNumberPoolStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -4,14 +4,143 @@
 // you may not use this file except in compliance with the License.
 
 #include "HAPPlatform.h"
+#include "HAPPlatformClock+Monotonic.h"
+#include "HAPPlatformRandomNumber+Pool.h"
+#include "HAPPlatformRunLoop+Priority.h"
 #include "HAPCrypto.h"
 
-void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
-    if (!bytes || !numBytes) return;
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "RandomNumber" };
+
+static HAPPlatformRandomNumberPoolStatistics stats;
+
+static uint32_t LatencySince(HAPMonotonicTime start) {
+    return (uint32_t)(HAPPlatformClockGetMonotonic() - start);
+}
+
+static void RecordRequest(HAPMonotonicTime start) {
+    uint32_t latency = LatencySince(start);
+
+    stats.numRequests++;
+    stats.totalLatency += latency;
 
+    if (latency > stats.maxLatency) {
+        stats.maxLatency = latency;
+    }
+}
+
+static CRYSError_t GenerateVector(void* bytes, size_t numBytes) {
     CRYSError_t err = CRYS_RND_GenerateVector(&rndState, numBytes, (uint8_t*)bytes);
 
     if (err) {
-        HAPLogError(&kHAPLog_Default, "CRYS_RND_GenerateVector failed %08x", err);
+        HAPLogError(&logObject, "CRYS_RND_GenerateVector failed %08x", err);
+    }
+    return err;
+}
+
+#if HAP_RANDOM_NUMBER_POOL_SIZE
+
+// Unused bytes are kept at the end of the buffer, consumed bytes are zeroed at the front.
+static struct {
+    uint8_t bytes[HAP_RANDOM_NUMBER_POOL_SIZE];
+    size_t numBytes;
+    size_t numRefillsSinceReseed;
+    bool isRefillScheduled;
+} pool;
+
+static void RefillPool(void* _Nullable context HAP_UNUSED, size_t contextSize HAP_UNUSED) {
+    pool.isRefillScheduled = false;
+
+    if (pool.numBytes == sizeof pool.bytes) return;
+
+    HAPMonotonicTime start = HAPPlatformClockGetMonotonic();
+
+    if (++pool.numRefillsSinceReseed >= HAP_RANDOM_NUMBER_POOL_RESEED_INTERVAL) {
+        CRYSError_t err = CRYS_RND_Reseeding(&rndState, &rndWorkBuff);
+
+        if (err) {
+            HAPLogError(&logObject, "CRYS_RND_Reseeding failed %08x", err);
+        } else {
+            pool.numRefillsSinceReseed = 0;
+            stats.numReseeds++;
+        }
+    }
+
+    // On failure the zeroed bytes stay consumed and requests fall back to CryptoCell until the next refill.
+    if (GenerateVector(pool.bytes, sizeof pool.bytes - pool.numBytes)) return;
+
+    pool.numBytes = sizeof pool.bytes;
+    stats.numRefills++;
+    stats.lastRefillLatency = LatencySince(start);
+
+    HAPLogDebug(&logObject, "Pool refilled: %lu hits, %lu refills, %lu stalls, %lu reseeds.",
+        (unsigned long)stats.numHits, (unsigned long)stats.numRefills, (unsigned long)stats.numStalls, (unsigned long)stats.numReseeds);
+}
+
+static void ScheduleRefill(void) {
+    if (pool.isRefillScheduled) return;
+
+    HAPError err = HAPPlatformRunLoopScheduleBackgroundCallback(RefillPool, NULL, 0);
+
+    if (err) {
+        HAPLogError(&logObject, "Failed to schedule pool refill %d", err);
+    } else {
+        pool.isRefillScheduled = true;
     }
 }
+
+void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
+    if (!bytes || !numBytes) return;
+
+    HAPMonotonicTime start = HAPPlatformClockGetMonotonic();
+
+    if (numBytes > sizeof pool.bytes) {
+        (void) GenerateVector(bytes, numBytes);
+        RecordRequest(start);
+        return;
+    }
+
+    if (numBytes > pool.numBytes) {
+        stats.numStalls++;
+        (void) GenerateVector(bytes, numBytes);
+        stats.lastStallLatency = LatencySince(start);
+    } else {
+        uint8_t* head = &pool.bytes[sizeof pool.bytes - pool.numBytes];
+
+        HAPRawBufferCopyBytes(bytes, head, numBytes);
+        HAPRawBufferZero(head, numBytes);
+        pool.numBytes -= numBytes;
+        stats.numHits++;
+    }
+
+    if (pool.numBytes < sizeof pool.bytes / 2) {
+        ScheduleRefill();
+    }
+    RecordRequest(start);
+}
+
+void HAPPlatformRandomNumberPoolPrefill(void) {
+    ScheduleRefill();
+}
+
+#else
+
+void HAPPlatformRandomNumberFill(void* bytes, size_t numBytes) {
+    if (!bytes || !numBytes) return;
+
+    HAPMonotonicTime start = HAPPlatformClockGetMonotonic();
+
+    (void) GenerateVector(bytes, numBytes);
+    stats.lastStallLatency = LatencySince(start);
+    RecordRequest(start);
+}
+
+void HAPPlatformRandomNumberPoolPrefill(void) {
+}
+
+#endif
+
+void HAPPlatformRandomNumberPoolGetStatistics(HAPPlatformRandomNumberPoolStatistics* statistics) {
+    HAPPrecondition(statistics);
+
+    *statistics = stats;
+}
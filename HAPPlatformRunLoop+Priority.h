@@ -0,0 +1,86 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_RUN_LOOP_PRIORITY_H
+#define HAP_PLATFORM_RUN_LOOP_PRIORITY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Run loop queue priority.
+ */
+HAP_ENUM_BEGIN(uint8_t, HAPPlatformRunLoopPriority) {
+    /** BLE stack events, HAP protocol work and timers. */
+    kHAPPlatformRunLoopPriority_High,
+
+    /** Persistence, logging and housekeeping. Only dispatched while no high priority work is pending. */
+    kHAPPlatformRunLoopPriority_Background
+} HAP_ENUM_END(uint8_t, HAPPlatformRunLoopPriority);
+
+/**
+ * Run loop queue statistics.
+ */
+typedef struct {
+    /** Number of dispatched events. */
+    uint32_t numEvents;
+
+    /** Number of events posted for immediate dispatch that have not been dispatched yet. */
+    uint32_t depth;
+
+    /** Maximum depth. */
+    uint32_t maxDepth;
+
+    /** Time in microseconds between the last event becoming due and its dispatch. */
+    uint32_t lastLatency;
+
+    /** Maximum latency in microseconds. */
+    uint32_t maxLatency;
+
+    /** Maximum latency in microseconds since the last HAPPlatformRunLoopResetPeriod. */
+    uint32_t periodMaxLatency;
+} HAPPlatformRunLoopQueueStatistics;
+
+/**
+ * Schedules a callback on the background queue.
+ *
+ * @param      callback             Function to call.
+ * @param      context              Context that is passed to the callback.
+ * @param      contextSize          Size of the context data.
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_OutOfResources If the queue has no memory left for the event.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformRunLoopScheduleBackgroundCallback(
+        HAPPlatformRunLoopCallback callback,
+        void* _Nullable context,
+        size_t contextSize);
+
+/**
+ * Fetches the statistics of a run loop queue.
+ *
+ * @param      priority             Queue priority.
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformRunLoopGetStatistics(
+        HAPPlatformRunLoopPriority priority,
+        HAPPlatformRunLoopQueueStatistics* statistics);
+
+/**
+ * Starts a new period for the per-period statistics of a run loop queue.
+ *
+ * @param      priority             Queue priority.
+ */
+void HAPPlatformRunLoopResetPeriod(HAPPlatformRunLoopPriority priority);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -5,15 +5,104 @@
 
 #include "HAPPlatformRunLoop+Init.h"
 #include "HAPMbed.h"
+#include "HAPPlatformRandomNumber+Pool.h"
+#include "HAPPlatformTelemetry.h"
+
+#include "platform/mbed_atomic.h"
 
 events::EventQueue eventQueue;
+events::EventQueue backgroundQueue;
+
+static HAPPlatformRunLoopQueueStatistics _stats[2];
+static int _backgroundDispatchId = 0;
+
+static void dispatchBackground(bool hasYielded) {
+    _backgroundDispatchId = 0;
+
+    // Yield to high priority events that were posted in the meantime. Going through eventQueue once more also lets
+    // timers that became due run first, as they are ordered before the re-posted dispatch. The check happens once per
+    // round, events that are due together are dispatched back to back by dispatch_once.
+    if (!hasYielded || core_util_atomic_load_u32(&_stats[kHAPPlatformRunLoopPriority_High].depth)) {
+        _backgroundDispatchId = eventQueue.call(dispatchBackground, true);
+        return;
+    }
+    backgroundQueue.dispatch_once();
+}
+
+static void updateBackground(int ms) {
+    if (_backgroundDispatchId) {
+        eventQueue.cancel(_backgroundDispatchId);
+        _backgroundDispatchId = 0;
+    }
+    if (ms >= 0) {
+        _backgroundDispatchId = eventQueue.call_in(std::chrono::milliseconds(ms), dispatchBackground, false);
+    }
+}
+
+static void eventDidCancel(HAPPlatformRunLoopPriority priority) {
+    core_util_atomic_decr_u32(&_stats[priority].depth, 1);
+}
+
+void HAPMbedInternal::EventWillPost(HAPPlatformRunLoopPriority priority) {
+    auto &stats = _stats[priority];
+    auto depth = core_util_atomic_incr_u32(&stats.depth, 1);
+
+    if (depth > stats.maxDepth) {
+        stats.maxDepth = depth;
+    }
+}
+
+void HAPMbedInternal::EventDidPost(HAPPlatformRunLoopPriority priority, int id) {
+    if (!id) {
+        eventDidCancel(priority);
+    }
+}
+
+void HAPMbedInternal::EventWillDispatch(HAPPlatformRunLoopPriority priority, HAPMonotonicTime due, bool isImmediate) {
+    auto &stats = _stats[priority];
+    auto now = HAPPlatformClockGetMonotonic();
+    auto latency = (uint32_t)(now > due ? now - due : 0);
+
+    if (isImmediate) {
+        core_util_atomic_decr_u32(&stats.depth, 1);
+    }
+    stats.numEvents++;
+    stats.lastLatency = latency;
+
+    if (latency > stats.maxLatency) {
+        stats.maxLatency = latency;
+    }
+    if (latency > stats.periodMaxLatency) {
+        stats.periodMaxLatency = latency;
+    }
+}
+
+bool HAPMbedCancelEvent(HAPPlatformRunLoopPriority priority, int id, bool isImmediate) {
+    auto &queue = priority == kHAPPlatformRunLoopPriority_High ? eventQueue : backgroundQueue;
+
+    if (!id || !queue.cancel(id)) return false;
+
+    if (isImmediate) {
+        eventDidCancel(priority);
+    }
+    return true;
+}
 
 void HAPPlatformRunLoopCreate(const HAPPlatformRunLoopOptions* options) {
     HAPPrecondition(options);
     HAPPrecondition(options->keyValueStore);
+
+    backgroundQueue.background(updateBackground);
+
+    HAPPlatformRandomNumberPoolPrefill();
+
+    HAPPlatformTelemetryStart();
 }
 
 void HAPPlatformRunLoopRelease(void) {
+    HAPPlatformTelemetryStop();
+
+    backgroundQueue.background(nullptr);
 }
 
 void HAPPlatformRunLoopRun(void) {
@@ -25,10 +114,38 @@ HAPError HAPPlatformRunLoopScheduleCallback(
         HAPPlatformRunLoopCallback callback,
         void* _Nullable context,
         size_t contextSize) {
-    eventQueue.call(callback, context, contextSize);
+    if (!HAPMbedPostEvent(kHAPPlatformRunLoopPriority_High, [callback, context, contextSize] { callback(context, contextSize); })) {
+        return kHAPError_OutOfResources;
+    }
     return kHAPError_None;
 }
 
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformRunLoopScheduleBackgroundCallback(
+        HAPPlatformRunLoopCallback callback,
+        void* _Nullable context,
+        size_t contextSize) {
+    if (!HAPMbedPostEvent(kHAPPlatformRunLoopPriority_Background, [callback, context, contextSize] { callback(context, contextSize); })) {
+        return kHAPError_OutOfResources;
+    }
+    return kHAPError_None;
+}
+
+void HAPPlatformRunLoopGetStatistics(
+        HAPPlatformRunLoopPriority priority,
+        HAPPlatformRunLoopQueueStatistics* statistics) {
+    HAPPrecondition(priority <= kHAPPlatformRunLoopPriority_Background);
+    HAPPrecondition(statistics);
+
+    *statistics = _stats[priority];
+}
+
+void HAPPlatformRunLoopResetPeriod(HAPPlatformRunLoopPriority priority) {
+    HAPPrecondition(priority <= kHAPPlatformRunLoopPriority_Background);
+
+    _stats[priority].periodMaxLatency = 0;
+}
+
 void HAPPlatformRunLoopStop(void) {
     eventQueue.break_dispatch();
 }
@@ -0,0 +1,224 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#include "HAPPlatform.h"
+#include "HAPPlatformClock+Monotonic.h"
+#include "HAPPlatformRunLoop+Priority.h"
+#include "HAPPlatformSRP.h"
+#include "HAPCrypto.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "SRP" };
+
+CRYS_SRP_Context_t srpContext;
+
+static HAPPlatformSRPStatistics stats;
+
+// The private key b of a precomputed ephemeral lives in srpContext, which is why precomputation only runs while no
+// central is connected and therefore no pair setup can be in progress.
+static struct {
+    uint8_t salt[SRP_SALT_BYTES];
+    uint8_t verifier[SRP_VERIFIER_BYTES];
+    uint8_t publicKey[SRP_PUBLIC_KEY_BYTES];
+    HAPPlatformTimerRef expiryTimer;
+    HAPMonotonicTime start;
+    bool isAvailable;
+    bool isEnabled;
+    bool isConnected;
+    bool isScheduled;
+    bool wasPrecomputed;
+} ephemeral;
+
+static HAPError InitializeContext(uint8_t* salt, uint8_t* verifier) {
+    static uint8_t user[] = "Pair-Setup";
+    static uint8_t pass[] = HAP_SETUP_CODE;
+    static CRYS_SRP_Modulus_t srpModulus = {
+        0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xc9, 0x0f, 0xda, 0xa2, 0x21, 0x68, 0xc2, 0x34,
+        0xc4, 0xc6, 0x62, 0x8b, 0x80, 0xdc, 0x1c, 0xd1, 0x29, 0x02, 0x4e, 0x08, 0x8a, 0x67, 0xcc, 0x74,
+        0x02, 0x0b, 0xbe, 0xa6, 0x3b, 0x13, 0x9b, 0x22, 0x51, 0x4a, 0x08, 0x79, 0x8e, 0x34, 0x04, 0xdd,
+        0xef, 0x95, 0x19, 0xb3, 0xcd, 0x3a, 0x43, 0x1b, 0x30, 0x2b, 0x0a, 0x6d, 0xf2, 0x5f, 0x14, 0x37,
+        0x4f, 0xe1, 0x35, 0x6d, 0x6d, 0x51, 0xc2, 0x45, 0xe4, 0x85, 0xb5, 0x76, 0x62, 0x5e, 0x7e, 0xc6,
+        0xf4, 0x4c, 0x42, 0xe9, 0xa6, 0x37, 0xed, 0x6b, 0x0b, 0xff, 0x5c, 0xb6, 0xf4, 0x06, 0xb7, 0xed,
+        0xee, 0x38, 0x6b, 0xfb, 0x5a, 0x89, 0x9f, 0xa5, 0xae, 0x9f, 0x24, 0x11, 0x7c, 0x4b, 0x1f, 0xe6,
+        0x49, 0x28, 0x66, 0x51, 0xec, 0xe4, 0x5b, 0x3d, 0xc2, 0x00, 0x7c, 0xb8, 0xa1, 0x63, 0xbf, 0x05,
+        0x98, 0xda, 0x48, 0x36, 0x1c, 0x55, 0xd3, 0x9a, 0x69, 0x16, 0x3f, 0xa8, 0xfd, 0x24, 0xcf, 0x5f,
+        0x83, 0x65, 0x5d, 0x23, 0xdc, 0xa3, 0xad, 0x96, 0x1c, 0x62, 0xf3, 0x56, 0x20, 0x85, 0x52, 0xbb,
+        0x9e, 0xd5, 0x29, 0x07, 0x70, 0x96, 0x96, 0x6d, 0x67, 0x0c, 0x35, 0x4e, 0x4a, 0xbc, 0x98, 0x04,
+        0xf1, 0x74, 0x6c, 0x08, 0xca, 0x18, 0x21, 0x7c, 0x32, 0x90, 0x5e, 0x46, 0x2e, 0x36, 0xce, 0x3b,
+        0xe3, 0x9e, 0x77, 0x2c, 0x18, 0x0e, 0x86, 0x03, 0x9b, 0x27, 0x83, 0xa2, 0xec, 0x07, 0xa2, 0x8f,
+        0xb5, 0xc5, 0x5d, 0xf0, 0x6f, 0x4c, 0x52, 0xc9, 0xde, 0x2b, 0xcb, 0xf6, 0x95, 0x58, 0x17, 0x18,
+        0x39, 0x95, 0x49, 0x7c, 0xea, 0x95, 0x6a, 0xe5, 0x15, 0xd2, 0x26, 0x18, 0x98, 0xfa, 0x05, 0x10,
+        0x15, 0x72, 0x8e, 0x5a, 0x8a, 0xaa, 0xc4, 0x2d, 0xad, 0x33, 0x17, 0x0d, 0x04, 0x50, 0x7a, 0x33,
+        0xa8, 0x55, 0x21, 0xab, 0xdf, 0x1c, 0xba, 0x64, 0xec, 0xfb, 0x85, 0x04, 0x58, 0xdb, 0xef, 0x0a,
+        0x8a, 0xea, 0x71, 0x57, 0x5d, 0x06, 0x0c, 0x7d, 0xb3, 0x97, 0x0f, 0x85, 0xa6, 0xe1, 0xe4, 0xc7,
+        0xab, 0xf5, 0xae, 0x8c, 0xdb, 0x09, 0x33, 0xd7, 0x1e, 0x8c, 0x94, 0xe0, 0x4a, 0x25, 0x61, 0x9d,
+        0xce, 0xe3, 0xd2, 0x26, 0x1a, 0xd2, 0xee, 0x6b, 0xf1, 0x2f, 0xfa, 0x06, 0xd9, 0x8a, 0x08, 0x64,
+        0xd8, 0x76, 0x02, 0x73, 0x3e, 0xc8, 0x6a, 0x64, 0x52, 0x1f, 0x2b, 0x18, 0x17, 0x7b, 0x20, 0x0c,
+        0xbb, 0xe1, 0x17, 0x57, 0x7a, 0x61, 0x5d, 0x6c, 0x77, 0x09, 0x88, 0xc0, 0xba, 0xd9, 0x46, 0xe2,
+        0x08, 0xe2, 0x4f, 0xa0, 0x74, 0xe5, 0xab, 0x31, 0x43, 0xdb, 0x5b, 0xfc, 0xe0, 0xfd, 0x10, 0x8e,
+        0x4b, 0x82, 0xd1, 0x20, 0xa9, 0x3a, 0xd2, 0xca, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff
+    };
+    CRYSError_t err = CRYS_SRP_HK_INIT(CRYS_SRP_HOST, srpModulus, 0x05, CRYS_SRP_MAX_MODULUS_IN_BITS, user, sizeof user - 1, pass, sizeof pass - 1, &rndState, CRYS_RND_GenerateVector, &srpContext);
+
+    if (err) {
+        HAPLogError(&logObject, "CRYS_SRP_HK_INIT failed %08x", err);
+        return kHAPError_Unknown;
+    }
+
+    err = CRYS_SRP_PwdVerCreate(SRP_SALT_BYTES, salt, verifier, &srpContext);
+
+    if (err) {
+        HAPLogError(&logObject, "CRYS_SRP_PwdVerCreate failed %08x", err);
+        return kHAPError_Unknown;
+    }
+    return kHAPError_None;
+}
+
+static void DiscardEphemeral(void) {
+    if (ephemeral.expiryTimer) {
+        HAPPlatformTimerDeregister(ephemeral.expiryTimer);
+        ephemeral.expiryTimer = 0;
+    }
+    HAPRawBufferZero(ephemeral.salt, sizeof ephemeral.salt);
+    HAPRawBufferZero(ephemeral.verifier, sizeof ephemeral.verifier);
+    HAPRawBufferZero(ephemeral.publicKey, sizeof ephemeral.publicKey);
+    ephemeral.isAvailable = false;
+}
+
+static void SchedulePrecomputation(void);
+
+static void HandleExpiryTimer(HAPPlatformTimerRef timer HAP_UNUSED, void* _Nullable context HAP_UNUSED) {
+    ephemeral.expiryTimer = 0;
+
+    if (!ephemeral.isAvailable) return;
+
+    HAPLogDebug(&logObject, "Precomputed ephemeral expired.");
+    DiscardEphemeral();
+    stats.numExpired++;
+
+    CRYSError_t err = CRYS_SRP_Clear(&srpContext);
+
+    if (err) {
+        HAPLogError(&logObject, "CRYS_SRP_Clear failed %08x", err);
+    }
+    SchedulePrecomputation();
+}
+
+static void Precompute(void* _Nullable context HAP_UNUSED, size_t contextSize HAP_UNUSED) {
+    ephemeral.isScheduled = false;
+
+    if (!ephemeral.isEnabled || ephemeral.isConnected || ephemeral.isAvailable) return;
+
+    HAPMonotonicTime start = HAPPlatformClockGetMonotonic();
+
+    if (InitializeContext(ephemeral.salt, ephemeral.verifier)) return;
+
+    CRYSError_t err = CRYS_SRP_HostPubKeyCreate(SRP_SECRET_KEY_BYTES, ephemeral.verifier, ephemeral.publicKey, &srpContext);
+
+    if (err) {
+        HAPLogError(&logObject, "CRYS_SRP_HostPubKeyCreate failed %08x", err);
+        DiscardEphemeral();
+        return;
+    }
+
+    HAPError hapErr = HAPPlatformTimerRegister(
+            &ephemeral.expiryTimer,
+            HAPPlatformClockGetCurrent() + HAP_SRP_PRECOMPUTED_EPHEMERAL_LIFETIME,
+            HandleExpiryTimer,
+            NULL);
+
+    if (hapErr) {
+        HAPLogError(&logObject, "Failed to register expiry timer %d", hapErr);
+        DiscardEphemeral();
+        return;
+    }
+    ephemeral.isAvailable = true;
+    stats.numPrecomputed++;
+
+    HAPLogDebug(&logObject, "Precomputed ephemeral in %lu us.", (unsigned long)(HAPPlatformClockGetMonotonic() - start));
+}
+
+static void SchedulePrecomputation(void) {
+    if (!ephemeral.isEnabled || ephemeral.isConnected || ephemeral.isAvailable || ephemeral.isScheduled) return;
+
+    HAPError err = HAPPlatformRunLoopScheduleBackgroundCallback(Precompute, NULL, 0);
+
+    if (err) {
+        HAPLogError(&logObject, "Failed to schedule precomputation %d", err);
+    } else {
+        ephemeral.isScheduled = true;
+    }
+}
+
+HAPError HAPPlatformSRPCreateVerifier(uint8_t* salt, uint8_t* verifier) {
+    HAPPrecondition(salt);
+    HAPPrecondition(verifier);
+
+    ephemeral.start = HAPPlatformClockGetMonotonic();
+    ephemeral.wasPrecomputed = ephemeral.isAvailable;
+
+    // srpContext now belongs to this pair setup until it is advertised as unpaired again.
+    HAPPlatformSRPStopPrecomputation();
+
+    if (ephemeral.isAvailable) {
+        HAPRawBufferCopyBytes(salt, ephemeral.salt, sizeof ephemeral.salt);
+        HAPRawBufferCopyBytes(verifier, ephemeral.verifier, sizeof ephemeral.verifier);
+        return kHAPError_None;
+    }
+    return InitializeContext(salt, verifier);
+}
+
+HAPError HAPPlatformSRPCreatePublicKey(const uint8_t* verifier, uint8_t* publicKey) {
+    HAPPrecondition(verifier);
+    HAPPrecondition(publicKey);
+
+    if (ephemeral.isAvailable && HAPRawBufferAreEqual(verifier, ephemeral.verifier, sizeof ephemeral.verifier)) {
+        HAPRawBufferCopyBytes(publicKey, ephemeral.publicKey, sizeof ephemeral.publicKey);
+        DiscardEphemeral();
+    } else {
+        // b is about to be replaced, so the precomputed B must not be handed out anymore.
+        DiscardEphemeral();
+
+        CRYSError_t err = CRYS_SRP_HostPubKeyCreate(SRP_SECRET_KEY_BYTES, verifier, publicKey, &srpContext);
+
+        if (err) {
+            HAPLogError(&logObject, "CRYS_SRP_HostPubKeyCreate failed %08x", err);
+            return kHAPError_Unknown;
+        }
+        ephemeral.wasPrecomputed = false;
+    }
+
+    uint32_t latency = (uint32_t)(HAPPlatformClockGetMonotonic() - ephemeral.start);
+
+    if (ephemeral.wasPrecomputed) {
+        stats.numHits++;
+        stats.lastHitLatency = latency;
+    } else {
+        stats.numMisses++;
+        stats.lastMissLatency = latency;
+    }
+    HAPLog(&logObject, "Pair Setup M2 SRP took %lu us (%s).", (unsigned long)latency, ephemeral.wasPrecomputed ? "precomputed" : "inline");
+
+    return kHAPError_None;
+}
+
+void HAPPlatformSRPStartPrecomputation(void) {
+    ephemeral.isEnabled = true;
+
+    SchedulePrecomputation();
+}
+
+void HAPPlatformSRPStopPrecomputation(void) {
+    ephemeral.isEnabled = false;
+}
+
+void HAPPlatformSRPSetConnected(bool isConnected) {
+    ephemeral.isConnected = isConnected;
+}
+
+void HAPPlatformSRPGetStatistics(HAPPlatformSRPStatistics* statistics) {
+    HAPPrecondition(statistics);
+
+    *statistics = stats;
+}
@@ -0,0 +1,102 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_SRP_H
+#define HAP_PLATFORM_SRP_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Time in milliseconds after which an unused precomputed SRP ephemeral is discarded and regenerated.
+ */
+#ifndef HAP_SRP_PRECOMPUTED_EPHEMERAL_LIFETIME
+#define HAP_SRP_PRECOMPUTED_EPHEMERAL_LIFETIME (5 * HAPMinute)
+#endif
+
+/**
+ * SRP statistics.
+ */
+typedef struct {
+    /** Number of ephemerals generated ahead of time. */
+    uint32_t numPrecomputed;
+
+    /** Number of precomputed ephemerals discarded because they were not used in time. */
+    uint32_t numExpired;
+
+    /** Number of Pair Setup M2 responses that used a precomputed ephemeral. */
+    uint32_t numHits;
+
+    /** Number of Pair Setup M2 responses that computed the ephemeral inline. */
+    uint32_t numMisses;
+
+    /** Time in microseconds spent on the SRP part of the last M2 that used a precomputed ephemeral. */
+    uint32_t lastHitLatency;
+
+    /** Time in microseconds spent on the SRP part of the last M2 that computed the ephemeral inline. */
+    uint32_t lastMissLatency;
+} HAPPlatformSRPStatistics;
+
+/**
+ * Creates a salt and the matching verifier for the setup code, initializing the global SRP context.
+ *
+ * If a precomputed ephemeral is available, its salt and verifier are returned instead.
+ *
+ * @param[out] salt                 Salt (SRP_SALT_BYTES).
+ * @param[out] verifier             Verifier (SRP_VERIFIER_BYTES).
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If CryptoCell failed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformSRPCreateVerifier(uint8_t* salt, uint8_t* verifier);
+
+/**
+ * Creates the accessory's public key B for the verifier returned by HAPPlatformSRPCreateVerifier.
+ *
+ * A matching precomputed ephemeral is consumed exactly once, otherwise b / B are generated inline.
+ *
+ * @param      verifier             Verifier (SRP_VERIFIER_BYTES).
+ * @param[out] publicKey            Public key B (SRP_PUBLIC_KEY_BYTES).
+ *
+ * @return kHAPError_None           If successful.
+ * @return kHAPError_Unknown        If CryptoCell failed.
+ */
+HAP_RESULT_USE_CHECK
+HAPError HAPPlatformSRPCreatePublicKey(const uint8_t* verifier, uint8_t* publicKey);
+
+/**
+ * Allows an ephemeral to be precomputed on the run loop. Called while the accessory is unpaired and advertising.
+ */
+void HAPPlatformSRPStartPrecomputation(void);
+
+/**
+ * Stops further precomputation. An ephemeral that is already available stays valid until it is used or expires.
+ */
+void HAPPlatformSRPStopPrecomputation(void);
+
+/**
+ * Tells whether a central is connected. No ephemeral is precomputed while connected, as a pair setup might be using
+ * the SRP context.
+ *
+ * @param      isConnected          Whether a central is connected.
+ */
+void HAPPlatformSRPSetConnected(bool isConnected);
+
+/**
+ * Fetches the SRP statistics.
+ *
+ * @param[out] statistics           Statistics.
+ */
+void HAPPlatformSRPGetStatistics(HAPPlatformSRPStatistics* statistics);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
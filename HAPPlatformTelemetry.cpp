@@ -0,0 +1,202 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#include <stdio.h>
+
+#include "platform/mbed_stats.h"
+
+#include "HAPPlatformTelemetry.h"
+#include "HAPPlatformBLEPeripheralManager+Statistics.h"
+#include "HAPPlatformKeyValueStore+Statistics.h"
+#include "HAPMbed.h"
+
+static const HAPLogObject logObject = { .subsystem = kHAPPlatform_LogSubsystem, .category = "Telemetry" };
+
+// Samples are written at next, the oldest one is overwritten once the buffer is full.
+static struct {
+    HAPPlatformTelemetrySample samples[HAP_TELEMETRY_NUM_SAMPLES];
+    size_t numSamples;
+    size_t next;
+} _ring;
+
+// Cumulative counters at the previous sample.
+static struct {
+    mbed_stats_cpu_t cpu;
+    HAPPlatformRunLoopQueueStatistics queues[2];
+    HAPPlatformKeyValueStoreStatistics keyValueStore;
+    HAPPlatformBLEPeripheralManagerStatistics ble;
+} _last;
+
+static int _sampleId = 0;
+
+static uint16_t delta16(uint32_t value, uint32_t lastValue) {
+    return (uint16_t)HAPMin(value - lastValue, (uint32_t)UINT16_MAX);
+}
+
+static void printSample(const HAPPlatformTelemetrySample &sample) {
+    printf("T,%lu,%u,%lu,%lu,%lu,%lu,%u,%u,%u,%u,%u,%u,%u,%u,%u\n",
+        (unsigned long)sample.timestamp, sample.cpuIdle,
+        (unsigned long)sample.heapSize, (unsigned long)sample.maxHeapSize, (unsigned long)sample.maxStackSize,
+        (unsigned long)sample.maxEventLatency, sample.numEvents, sample.numBackgroundEvents, sample.backgroundQueueDepth,
+        sample.numKeyValueStoreReads, sample.numKeyValueStoreWrites, sample.numKeyValueStoreErrors,
+        sample.numRequests, sample.numConnections, sample.isConnected);
+}
+
+static void takeSample() {
+    HAPPlatformTelemetrySample sample;
+    HAPRawBufferZero(&sample, sizeof sample);
+
+    sample.timestamp = (uint32_t)(HAPPlatformClockGetCurrent() / HAPSecond);
+
+    mbed_stats_cpu_t cpu;
+    mbed_stats_cpu_get(&cpu);
+
+    if (cpu.uptime > _last.cpu.uptime) {
+        sample.cpuIdle = (uint16_t)((cpu.idle_time - _last.cpu.idle_time) * 1000 / (cpu.uptime - _last.cpu.uptime));
+    }
+    _last.cpu = cpu;
+
+    mbed_stats_heap_t heap;
+    mbed_stats_heap_get(&heap);
+    sample.heapSize = heap.current_size;
+    sample.maxHeapSize = heap.max_size;
+
+    // The main thread, the idle thread, the timer thread and at most a few more.
+    mbed_stats_stack_t stacks[8];
+    auto numStacks = mbed_stats_stack_get_each(stacks, HAPArrayCount(stacks));
+
+    for (size_t i = 0; i < numStacks; ++i) {
+        sample.maxStackSize = HAPMax(sample.maxStackSize, stacks[i].max_size);
+    }
+
+    HAPPlatformRunLoopQueueStatistics queues[2];
+    HAPPlatformRunLoopGetStatistics(kHAPPlatformRunLoopPriority_High, &queues[kHAPPlatformRunLoopPriority_High]);
+    HAPPlatformRunLoopGetStatistics(kHAPPlatformRunLoopPriority_Background, &queues[kHAPPlatformRunLoopPriority_Background]);
+
+    sample.maxEventLatency = queues[kHAPPlatformRunLoopPriority_High].periodMaxLatency;
+    HAPPlatformRunLoopResetPeriod(kHAPPlatformRunLoopPriority_High);
+    sample.numEvents = delta16(
+        queues[kHAPPlatformRunLoopPriority_High].numEvents,
+        _last.queues[kHAPPlatformRunLoopPriority_High].numEvents);
+    sample.numBackgroundEvents = delta16(
+        queues[kHAPPlatformRunLoopPriority_Background].numEvents,
+        _last.queues[kHAPPlatformRunLoopPriority_Background].numEvents);
+    sample.backgroundQueueDepth = (uint16_t)HAPMin(queues[kHAPPlatformRunLoopPriority_Background].depth, (uint32_t)UINT16_MAX);
+    HAPRawBufferCopyBytes(_last.queues, queues, sizeof queues);
+
+    HAPPlatformKeyValueStoreStatistics keyValueStore;
+    HAPPlatformKeyValueStoreGetStatistics(&keyValueStore);
+
+    sample.numKeyValueStoreReads = delta16(keyValueStore.numReads, _last.keyValueStore.numReads);
+    sample.numKeyValueStoreWrites = delta16(
+        keyValueStore.numWrites + keyValueStore.numRemoves,
+        _last.keyValueStore.numWrites + _last.keyValueStore.numRemoves);
+    sample.numKeyValueStoreErrors = delta16(keyValueStore.numErrors, _last.keyValueStore.numErrors);
+    _last.keyValueStore = keyValueStore;
+
+    HAPPlatformBLEPeripheralManagerStatistics ble;
+    HAPPlatformBLEPeripheralManagerGetStatistics(&ble);
+
+    sample.numRequests = delta16(
+        ble.numReadRequests + ble.numWriteRequests,
+        _last.ble.numReadRequests + _last.ble.numWriteRequests);
+    sample.numConnections = (uint8_t)HAPMin(ble.numConnections - _last.ble.numConnections, (uint32_t)UINT8_MAX);
+    sample.isConnected = ble.isConnected;
+    _last.ble = ble;
+
+    _ring.samples[_ring.next] = sample;
+    _ring.next = (_ring.next + 1) % HAP_TELEMETRY_NUM_SAMPLES;
+    _ring.numSamples = HAPMin(_ring.numSamples + 1, (size_t)HAP_TELEMETRY_NUM_SAMPLES);
+
+#if HAP_TELEMETRY_SERIAL_DUMP
+    printSample(sample);
+#endif
+}
+
+static void scheduleSample() {
+    _sampleId = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_Background, std::chrono::milliseconds(HAP_TELEMETRY_PERIOD), [] {
+        takeSample();
+        scheduleSample();
+    });
+    if (!_sampleId) {
+        HAPLogError(&logObject, "Failed to schedule telemetry sample.");
+    }
+}
+
+void HAPPlatformTelemetryStart(void) {
+#if HAP_TELEMETRY_PERIOD
+    if (_sampleId) return;
+
+    // Counters of the first sample start from here.
+    mbed_stats_cpu_get(&_last.cpu);
+    scheduleSample();
+#endif
+}
+
+void HAPPlatformTelemetryStop(void) {
+    if (_sampleId) {
+        HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_Background, _sampleId, false);
+        _sampleId = 0;
+    }
+}
+
+size_t HAPPlatformTelemetryGetSamples(HAPPlatformTelemetrySample* samples, size_t maxSamples) {
+    HAPPrecondition(!maxSamples || samples);
+
+    auto numSamples = HAPMin(maxSamples, _ring.numSamples);
+    auto first = (_ring.next + HAP_TELEMETRY_NUM_SAMPLES - numSamples) % HAP_TELEMETRY_NUM_SAMPLES;
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        samples[i] = _ring.samples[(first + i) % HAP_TELEMETRY_NUM_SAMPLES];
+    }
+    return numSamples;
+}
+
+size_t HAPPlatformTelemetrySerialize(void* bytes, size_t maxBytes) {
+    HAPPrecondition(bytes);
+
+    if (maxBytes < 2) return 0;
+
+    HAPPlatformTelemetrySample samples[HAP_TELEMETRY_NUM_SAMPLES];
+    auto numSamples = HAPPlatformTelemetryGetSamples(samples, (maxBytes - 2) / kHAPPlatformTelemetry_SampleSize);
+    auto b = (uint8_t*)bytes;
+
+    *b++ = kHAPPlatformTelemetry_Version;
+    *b++ = (uint8_t)kHAPPlatformTelemetry_SampleSize;
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        auto &sample = samples[i];
+
+        HAPWriteLittleUInt32(b, sample.timestamp); b += 4;
+        HAPWriteLittleUInt32(b, sample.heapSize); b += 4;
+        HAPWriteLittleUInt32(b, sample.maxHeapSize); b += 4;
+        HAPWriteLittleUInt32(b, sample.maxStackSize); b += 4;
+        HAPWriteLittleUInt32(b, sample.maxEventLatency); b += 4;
+        HAPWriteLittleUInt16(b, sample.cpuIdle); b += 2;
+        HAPWriteLittleUInt16(b, sample.numEvents); b += 2;
+        HAPWriteLittleUInt16(b, sample.numBackgroundEvents); b += 2;
+        HAPWriteLittleUInt16(b, sample.backgroundQueueDepth); b += 2;
+        HAPWriteLittleUInt16(b, sample.numKeyValueStoreReads); b += 2;
+        HAPWriteLittleUInt16(b, sample.numKeyValueStoreWrites); b += 2;
+        HAPWriteLittleUInt16(b, sample.numKeyValueStoreErrors); b += 2;
+        HAPWriteLittleUInt16(b, sample.numRequests); b += 2;
+        *b++ = sample.numConnections;
+        *b++ = sample.isConnected;
+    }
+    return 2 + numSamples * kHAPPlatformTelemetry_SampleSize;
+}
+
+void HAPPlatformTelemetryDump(void) {
+    HAPPlatformTelemetrySample samples[HAP_TELEMETRY_NUM_SAMPLES];
+    auto numSamples = HAPPlatformTelemetryGetSamples(samples, HAPArrayCount(samples));
+
+    printf("T,timestamp,cpuIdle,heapSize,maxHeapSize,maxStackSize,maxEventLatency,numEvents,numBackgroundEvents,"
+        "backgroundQueueDepth,numKeyValueStoreReads,numKeyValueStoreWrites,numKeyValueStoreErrors,numRequests,"
+        "numConnections,isConnected\n");
+
+    for (size_t i = 0; i < numSamples; ++i) {
+        printSample(samples[i]);
+    }
+}
@@ -0,0 +1,146 @@
+// Copyright (c) 2022 Igor Pener
+//
+// Licensed under the Apache License, Version 2.0 (the “License”);
+// you may not use this file except in compliance with the License.
+
+#ifndef HAP_PLATFORM_TELEMETRY_H
+#define HAP_PLATFORM_TELEMETRY_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "HAPPlatform.h"
+
+/**
+ * Time in milliseconds between two telemetry samples. Set to 0 to disable telemetry.
+ */
+#ifndef HAP_TELEMETRY_PERIOD
+#define HAP_TELEMETRY_PERIOD 60000
+#endif
+
+/**
+ * Number of samples kept in the ring buffer.
+ */
+#ifndef HAP_TELEMETRY_NUM_SAMPLES
+#define HAP_TELEMETRY_NUM_SAMPLES 12
+#endif
+
+/**
+ * Set to 1 to print every sample as one line to the serial console.
+ */
+#ifndef HAP_TELEMETRY_SERIAL_DUMP
+#define HAP_TELEMETRY_SERIAL_DUMP 0
+#endif
+
+/**
+ * Set to 1 to publish the samples through a vendor GATT diagnostics service next to the HAP services.
+ */
+#ifndef HAP_TELEMETRY_GATT_SERVICE
+#define HAP_TELEMETRY_GATT_SERVICE 0
+#endif
+
+/**
+ * Version of the serialized sample format.
+ */
+#define kHAPPlatformTelemetry_Version ((uint8_t) 2)
+
+/**
+ * Size of a serialized sample in bytes.
+ */
+#define kHAPPlatformTelemetry_SampleSize ((size_t) 38)
+
+/**
+ * Telemetry sample. Counters and the event latency cover the period since the previous sample, memory high-water
+ * marks the time since boot.
+ */
+typedef struct {
+    /** Time in seconds since boot at which the sample was taken. */
+    uint32_t timestamp;
+
+    /** Heap currently in use in bytes. */
+    uint32_t heapSize;
+
+    /** Heap high-water mark in bytes. */
+    uint32_t maxHeapSize;
+
+    /** Highest stack high-water mark of any thread in bytes. */
+    uint32_t maxStackSize;
+
+    /** Maximum dispatch latency of the high priority queue during the period in microseconds. */
+    uint32_t maxEventLatency;
+
+    /** Share of the period the CPU spent idle in per mille. */
+    uint16_t cpuIdle;
+
+    /** Number of events dispatched from the high priority queue. */
+    uint16_t numEvents;
+
+    /** Number of events dispatched from the background queue. */
+    uint16_t numBackgroundEvents;
+
+    /** Number of background events waiting for dispatch when the sample was taken. */
+    uint16_t backgroundQueueDepth;
+
+    /** Number of key-value store lookups. */
+    uint16_t numKeyValueStoreReads;
+
+    /** Number of key-value store writes and removals. */
+    uint16_t numKeyValueStoreWrites;
+
+    /** Number of failed key-value store operations. */
+    uint16_t numKeyValueStoreErrors;
+
+    /** Number of ATT read and write requests. */
+    uint16_t numRequests;
+
+    /** Number of established connections. */
+    uint8_t numConnections;
+
+    /** Whether a central was connected when the sample was taken. */
+    bool isConnected;
+} HAPPlatformTelemetrySample;
+
+/**
+ * Starts taking samples every HAP_TELEMETRY_PERIOD milliseconds on the background queue.
+ */
+void HAPPlatformTelemetryStart(void);
+
+/**
+ * Stops taking samples. Samples taken so far are kept.
+ */
+void HAPPlatformTelemetryStop(void);
+
+/**
+ * Copies the buffered samples, oldest first.
+ *
+ * @param[out] samples              Samples.
+ * @param      maxSamples           Capacity of the samples buffer.
+ *
+ * @return Number of samples copied.
+ */
+size_t HAPPlatformTelemetryGetSamples(HAPPlatformTelemetrySample* samples, size_t maxSamples);
+
+/**
+ * Serializes the most recent samples that fit into a buffer.
+ *
+ * The format is the version, the sample size and the samples, oldest first, with all fields in declaration order and
+ * little-endian.
+ *
+ * @param[out] bytes                Buffer.
+ * @param      maxBytes             Capacity of the buffer.
+ *
+ * @return Number of bytes written.
+ */
+size_t HAPPlatformTelemetrySerialize(void* bytes, size_t maxBytes);
+
+/**
+ * Prints all buffered samples to the serial console, one line per sample.
+ */
+void HAPPlatformTelemetryDump(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -18,7 +18,7 @@ HAPError HAPPlatformTimerRegister(
     if (deadline > now) {
         interval = deadline - now;
     }
-    *timer = eventQueue.call_in(std::chrono::duration<int, std::milli>(interval), [timer, context, callback] {
+    *timer = HAPMbedPostEventIn(kHAPPlatformRunLoopPriority_High, std::chrono::milliseconds(interval), [timer, context, callback] {
         callback(*timer, context);
     });
 
@@ -26,7 +26,7 @@ HAPError HAPPlatformTimerRegister(
 }
 
 void HAPPlatformTimerDeregister(HAPPlatformTimerRef timer) {
-    if (!eventQueue.cancel(timer)) {
+    if (!HAPMbedCancelEvent(kHAPPlatformRunLoopPriority_High, (int)timer, false)) {
         HAPLogError(&kHAPLog_Default, "Failed to cancel timer %d", timer);
     }
 }